@@ -0,0 +1,28 @@
+#include "pepper_mesh.h"
+#include <stdio.h>
+
+// pre-converts a wavefront obj into the binary mesh format, which loads with little more than a memcpy
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <in.obj> <out.pglm>\n", argv[0]);
+        return 1;
+    }
+
+    pgl_mesh_t mesh;
+    pgl_error_t err = pgl_load_mesh(argv[1], &mesh);
+    if (err != PGL_NO_ERROR) {
+        fprintf(stderr, "couldn't load %s (error %u)\n", argv[1], err);
+        return 1;
+    }
+    err = pgl_save_mesh_binary(mesh, argv[2]);
+    if (err != PGL_NO_ERROR) {
+        fprintf(stderr, "couldn't write %s (error %u)\n", argv[2], err);
+        pgl_destroy_mesh(&mesh);
+        return 1;
+    }
+
+    printf("%zu vertices, %zu triangles, %zu lines\n", mesh.vertex_count, mesh.triangle_count, mesh.line_count);
+    pgl_destroy_mesh(&mesh);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "pepper_mesh.h"
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+// in units of radians
+#define YAW 0.45
+#define PITCH 2.6
+#define ROLL 0.9
+
+#define SCREEN_HEIGHT 40
+#define SCREEN_WIDTH 80
+
+void render_edge(pgl_screen_t* s, pgl_vector2_t* projected, bool* visible, unsigned int a, unsigned int b) {
+    // no clipping yet, so only draw edges that are entirely in view
+    if (visible[a] && visible[b]) {
+        pgl_render_line(s, projected[a], projected[b], 'O');
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <mesh.obj | mesh.pglm>\n", argv[0]);
+        return 1;
+    }
+
+    pgl_mesh_t mesh;
+    pgl_error_t err = pgl_load_mesh(argv[1], &mesh);
+    if (err != PGL_NO_ERROR) {
+        fprintf(stderr, "couldn't load %s (error %u)\n", argv[1], err);
+        return 1;
+    }
+
+    // squish the mesh into the unit sphere so the camera can always see all of it
+    double radius = 0.0;
+    for (size_t i = 0; i < mesh.vertex_count; i++) {
+        if (pgl_vector3_magnitude(mesh.vertices[i]) > radius) {
+            radius = pgl_vector3_magnitude(mesh.vertices[i]);
+        }
+    }
+    for (size_t i = 0; radius > 0.0 && i < mesh.vertex_count; i++) {
+        mesh.vertices[i] = pgl_vector3_scale(mesh.vertices[i], 1.0 / radius);
+    }
+
+    // dynamically allocated, freed at the bottom
+    pgl_vector2_t* projected_points = (pgl_vector2_t*)malloc(sizeof(pgl_vector2_t) * mesh.vertex_count + 1);
+    bool* visible = (bool*)malloc(sizeof(bool) * mesh.vertex_count + 1);
+    if (projected_points == NULL || visible == NULL) {
+        fprintf(stderr, "out of memory\n");
+        free(projected_points);
+        free(visible);
+        pgl_destroy_mesh(&mesh);
+        return 1;
+    }
+
+    pgl_camera_t cam = {
+        M_PI_2,
+        {0, 0, -3},
+        {0, 0, 1},
+        {1, 0, 0},
+    };
+
+    char screen_data[SCREEN_WIDTH][SCREEN_HEIGHT];
+    pgl_screen_t screen = {SCREEN_WIDTH, SCREEN_HEIGHT, (char*)screen_data};
+    while (true) {
+        pgl_screen_clear(&screen, ' ');
+        double scale = (double)clock() / CLOCKS_PER_SEC;
+        pgl_matrix33_t rotation_matrix = pgl_gen_rotation_matrix(YAW * scale, PITCH * scale, ROLL * scale);
+        for (size_t i = 0; i < mesh.vertex_count; i++) {
+            pgl_vector3_t rotated = pgl_apply_matrix33(rotation_matrix, mesh.vertices[i]);
+            visible[i] = pgl_project_2d(cam, rotated, &projected_points[i]);
+        }
+        for (size_t i = 0; i < mesh.triangle_count; i++) {
+            unsigned int* t = &mesh.triangles[3 * i];
+            render_edge(&screen, projected_points, visible, t[0], t[1]);
+            render_edge(&screen, projected_points, visible, t[1], t[2]);
+            render_edge(&screen, projected_points, visible, t[2], t[0]);
+        }
+        for (size_t i = 0; i < mesh.line_count; i++) {
+            render_edge(&screen, projected_points, visible, mesh.lines[2 * i], mesh.lines[2 * i + 1]);
+        }
+        pgl_draw_screen(screen, stdout);
+    }
+
+    free(projected_points);
+    free(visible);
+    pgl_destroy_mesh(&mesh);
+    return 0;
+}
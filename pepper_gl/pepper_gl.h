@@ -5,14 +5,144 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef PGL_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 /* errors */
 
 #define PGL_NO_ERROR 0
 #define PGL_DYNAMIC_ALLOCATION_FAILURE 1
+#define PGL_FILE_ACCESS_FAILURE 2
+#define PGL_MALFORMED_FILE 3
 
 typedef unsigned int pgl_error_t;
 
+/* threading */
+
+// define PGL_NO_THREADS before including this header to keep everything on the calling thread
+#define PGL_MAX_THREADS 16
+
+unsigned int pgl_thread_count(void) {
+#ifdef PGL_NO_THREADS
+    return 1;
+#else
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) {
+        return 1;
+    }
+    if (online > PGL_MAX_THREADS) {
+        return PGL_MAX_THREADS;
+    }
+    return (unsigned int)online;
+#endif
+}
+
+typedef void (*pgl_job_t)(void* ctx, unsigned int index);
+
+#ifndef PGL_NO_THREADS
+// worker threads are started the first time they're needed and then stick around for the life of the process,
+// since spawning and joining threads every frame costs more than rendering a small scene does
+
+typedef struct pgl_pool_t {
+    pthread_mutex_t dispatching; // held by whoever currently owns the workers
+    pthread_mutex_t lock;        // guards everything below
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    bool started;
+    unsigned long generation;
+    pgl_job_t job;
+    void* ctx;
+    unsigned int job_count;
+    unsigned int next_job;
+    unsigned int finished_jobs;
+} pgl_pool_t;
+
+pgl_pool_t pgl_pool = {
+    .dispatching = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+void pgl_pool_drain(void) {
+    // must be called with pgl_pool.lock held, and still holds it on return
+    while (pgl_pool.next_job < pgl_pool.job_count) {
+        unsigned int i = pgl_pool.next_job++;
+        pgl_job_t job = pgl_pool.job;
+        void* ctx = pgl_pool.ctx;
+        pthread_mutex_unlock(&pgl_pool.lock);
+        job(ctx, i);
+        pthread_mutex_lock(&pgl_pool.lock);
+        pgl_pool.finished_jobs++;
+        if (pgl_pool.finished_jobs == pgl_pool.job_count) {
+            pthread_cond_broadcast(&pgl_pool.done);
+        }
+    }
+}
+
+void* pgl_pool_worker(void* unused) {
+    (void)unused;
+    pthread_mutex_lock(&pgl_pool.lock);
+    unsigned long seen = pgl_pool.generation;
+    while (true) {
+        while (pgl_pool.generation == seen) {
+            pthread_cond_wait(&pgl_pool.wake, &pgl_pool.lock);
+        }
+        seen = pgl_pool.generation;
+        pgl_pool_drain();
+    }
+    return NULL;
+}
+
+void pgl_pool_start(unsigned int worker_count) {
+    // a thread we couldn't get just means the caller picks up more of the work itself
+    for (unsigned int i = 1; i < worker_count; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, pgl_pool_worker, NULL) == 0) {
+            pthread_detach(thread);
+        }
+    }
+    pgl_pool.started = true;
+}
+#endif
+
+void pgl_parallel_for(pgl_job_t job, void* ctx, unsigned int job_count) {
+    // calls job(ctx, i) for every i below job_count, spread across up to pgl_thread_count() threads
+    // jobs run in no particular order, so they'd better not write to each other's outputs
+    // if the workers are already busy (another thread, or a job calling this), the jobs just run right here
+
+#ifndef PGL_NO_THREADS
+    if (job_count > 1 && pgl_thread_count() > 1 && pthread_mutex_trylock(&pgl_pool.dispatching) == 0) {
+        if (!pgl_pool.started) {
+            pgl_pool_start(pgl_thread_count());
+        }
+        pthread_mutex_lock(&pgl_pool.lock);
+        pgl_pool.job = job;
+        pgl_pool.ctx = ctx;
+        pgl_pool.job_count = job_count;
+        pgl_pool.next_job = 0;
+        pgl_pool.finished_jobs = 0;
+        pgl_pool.generation++;
+        pthread_cond_broadcast(&pgl_pool.wake);
+        pgl_pool_drain();
+        while (pgl_pool.finished_jobs < job_count) {
+            pthread_cond_wait(&pgl_pool.done, &pgl_pool.lock);
+        }
+        pthread_mutex_unlock(&pgl_pool.lock);
+        pthread_mutex_unlock(&pgl_pool.dispatching);
+        return;
+    }
+#endif
+
+    for (unsigned int i = 0; i < job_count; i++) {
+        job(ctx, i);
+    }
+}
+
 /* pgl_vector2_t and associated operations */
 
 typedef struct pgl_vector2_t {
@@ -132,14 +262,15 @@ typedef struct pgl_camera_t {
     pgl_vector3_t right;
 } pgl_camera_t;
 
-bool pgl_project_2d(pgl_camera_t cam, pgl_vector3_t in, pgl_vector2_t* out) {
-    // return value is whether or not point is in view of camera
-    // out has x and y in the range from -1 to 1 if in view of camera
+pgl_vector3_t pgl_camera_up(pgl_camera_t cam) { return pgl_vector3_cross(cam.right, cam.forward); }
+
+bool pgl_project_2d_with_up(pgl_camera_t cam, pgl_vector3_t up, pgl_vector3_t in, pgl_vector2_t* out) {
+    // same as pgl_project_2d, but takes pgl_camera_up(cam) precomputed for when projecting lots of points
 
     in = pgl_vector3_add(in, pgl_vector3_scale(cam.position, -1.0));
     pgl_vector3_t camera_space = {
         pgl_vector3_dot(cam.right, in),
-        pgl_vector3_dot(pgl_vector3_cross(cam.right, cam.forward), in),
+        pgl_vector3_dot(up, in),
         pgl_vector3_dot(cam.forward, in),
     };
 
@@ -149,6 +280,12 @@ bool pgl_project_2d(pgl_camera_t cam, pgl_vector3_t in, pgl_vector2_t* out) {
     return (-1 <= out->x && out->x <= 1) && (-1 <= out->y && out->y <= 1);
 }
 
+bool pgl_project_2d(pgl_camera_t cam, pgl_vector3_t in, pgl_vector2_t* out) {
+    // return value is whether or not point is in view of camera
+    // out has x and y in the range from -1 to 1 if in view of camera
+    return pgl_project_2d_with_up(cam, pgl_camera_up(cam), in, out);
+}
+
 /* pgl_screen_t and its associated operations */
 
 typedef struct pgl_screen_t {
@@ -190,12 +327,77 @@ void pgl_render_line(pgl_screen_t* s, pgl_vector2_t a, pgl_vector2_t b, char col
     for (size_t i = 0; i < steps; i++) {
         size_t transformed_x = (size_t)floor(s->width * (current_x + 1) / 2);
         size_t transformed_y = (size_t)floor(s->height * (current_y + 1) / 2);
+        // a coordinate of exactly 1 is still in view, but would land one past the last row/column
+        if (transformed_x >= s->width) {
+            transformed_x = s->width - 1;
+        }
+        if (transformed_y >= s->height) {
+            transformed_y = s->height - 1;
+        }
         s->buf[transformed_x + transformed_y * s->width] = color;
         current_x = a.x + (b.x - a.x) * ((double)i / steps);
         current_y = a.y + m * (current_x - a.x);
     }
 }
 
+/* fixed-size screens */
+
+// PGL_DEFINE_FIXED_SCREEN(name, width, height) generates pgl_screen_<name>_t along with pgl_screen_<name>_clear,
+// pgl_draw_screen_<name>, and pgl_render_line_<name>, all with the dimensions baked in as constants
+// same behavior as the pgl_screen_t versions, but the compiler gets to fold the strides and vectorize the fills
+// pgl_screen_<name>_as_screen hands back a regular pgl_screen_t over the same memory for everything else
+
+#define PGL_DEFINE_FIXED_SCREEN(name, w, h)                                                                            \
+    typedef struct pgl_screen_##name##_t {                                                                             \
+        char buf[h][w];                                                                                                \
+    } pgl_screen_##name##_t;                                                                                           \
+                                                                                                                       \
+    pgl_screen_t pgl_screen_##name##_as_screen(pgl_screen_##name##_t* s) {                                             \
+        pgl_screen_t res = {w, h, (char*)s->buf};                                                                      \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+                                                                                                                       \
+    void pgl_screen_##name##_clear(pgl_screen_##name##_t* s, char color) { memset(s->buf, color, sizeof(s->buf)); }    \
+                                                                                                                       \
+    void pgl_draw_screen_##name(const pgl_screen_##name##_t* s, FILE* out) {                                           \
+        /* lay the whole frame out with its newlines first so it goes out in a single write */                         \
+        char frame[h][(w) + 1];                                                                                        \
+        for (size_t line = 0; line < (h); line++) {                                                                    \
+            memcpy(frame[line], s->buf[line], (w));                                                                    \
+            frame[line][w] = '\n';                                                                                     \
+        }                                                                                                              \
+        if (out == stdout) {                                                                                           \
+            fprintf(out, "\033[H\033[2J"); /* clear screen and pointer to home position */                             \
+        }                                                                                                              \
+        fwrite(frame, sizeof(frame), 1, out);                                                                          \
+        fflush(out);                                                                                                   \
+    }                                                                                                                  \
+                                                                                                                       \
+    void pgl_render_line_##name(pgl_screen_##name##_t* s, pgl_vector2_t a, pgl_vector2_t b, char color) {              \
+        /* see pgl_render_line, this is the same walk with constant dimensions */                                      \
+        size_t steps = (size_t)ceil(fabs(a.x - b.x) / 2 * (w));                                                        \
+        if ((size_t)ceil(fabs(a.y - b.y) / 2 * (h)) > steps) {                                                         \
+            steps = (size_t)ceil(fabs(a.y - b.y) / 2 * (h));                                                           \
+        }                                                                                                              \
+                                                                                                                       \
+        double m = (b.y - a.y) / (b.x - a.x);                                                                          \
+        double current_x = a.x;                                                                                        \
+        double current_y = a.y;                                                                                        \
+        for (size_t i = 0; i < steps; i++) {                                                                           \
+            size_t transformed_x = (size_t)floor((w) * (current_x + 1) / 2);                                           \
+            size_t transformed_y = (size_t)floor((h) * (current_y + 1) / 2);                                           \
+            if (transformed_x >= (w)) {                                                                                \
+                transformed_x = (w) - 1;                                                                               \
+            }                                                                                                          \
+            if (transformed_y >= (h)) {                                                                                \
+                transformed_y = (h) - 1;                                                                               \
+            }                                                                                                          \
+            s->buf[transformed_y][transformed_x] = color;                                                              \
+            current_x = a.x + (b.x - a.x) * ((double)i / steps);                                                       \
+            current_y = a.y + m * (current_x - a.x);                                                                   \
+        }                                                                                                              \
+    }
+
 /* pgl_triangle_t, pgl_line_t, and associated operations */
 
 typedef enum pgl_geometry_type_t {
@@ -253,13 +455,15 @@ void pgl_destroy_renderschedule(pgl_renderschedule_t* sched) {
 }
 
 pgl_error_t pgl_expand_renderschedule(pgl_renderschedule_t* sched) {
-    sched->allocated *= 2;
-    sched->buf = (pgl_renderschedule_entry_t*)realloc(sched->buf, sched->allocated);
-    if (sched->buf == NULL) {
+    // on failure the old buffer is left alone so it can still be freed with pgl_destroy_renderschedule
+    pgl_renderschedule_entry_t* expanded = (pgl_renderschedule_entry_t*)realloc(
+        sched->buf, sizeof(pgl_renderschedule_entry_t) * sched->allocated * 2);
+    if (expanded == NULL) {
         return PGL_DYNAMIC_ALLOCATION_FAILURE;
-    } else {
-        return PGL_NO_ERROR;
     }
+    sched->buf = expanded;
+    sched->allocated *= 2;
+    return PGL_NO_ERROR;
 }
 
 pgl_error_t pgl_schedule_triangle(pgl_renderschedule_t* sched, pgl_triangle_t t, char color) {
@@ -294,7 +498,142 @@ pgl_error_t pgl_schedule_line(pgl_renderschedule_t* sched, pgl_line_t l, char co
     return PGL_NO_ERROR;
 }
 
-void pgl_submit_renderschedule(pgl_screen_t* s);
+/* pgl_view_t and multi-view submission */
+
+// schedules with fewer entries than this (per block, or across all views) aren't worth handing to other threads
+#define PGL_SUBMIT_MIN_BLOCK_LENGTH 4096
+
+typedef struct pgl_view_t {
+    pgl_camera_t cam;
+    pgl_screen_t* screen;
+} pgl_view_t;
+
+typedef struct pgl_submission_t {
+    pgl_matrix33_t transform;
+    const pgl_renderschedule_entry_t* in;
+    pgl_renderschedule_entry_t* transformed;
+    size_t length;
+    size_t block_length;
+    pgl_view_t* views;
+    unsigned int view_count;
+} pgl_submission_t;
+
+void pgl_transform_job(void* ctx, unsigned int index) {
+    pgl_submission_t* sub = (pgl_submission_t*)ctx;
+    size_t end = (index + 1) * sub->block_length;
+    if (end > sub->length) {
+        end = sub->length;
+    }
+    for (size_t i = index * sub->block_length; i < end; i++) {
+        pgl_renderschedule_entry_t entry = sub->in[i];
+        if (entry.type == PGL_TRIANGLE) {
+            entry.triangle.a = pgl_apply_matrix33(sub->transform, entry.triangle.a);
+            entry.triangle.b = pgl_apply_matrix33(sub->transform, entry.triangle.b);
+            entry.triangle.c = pgl_apply_matrix33(sub->transform, entry.triangle.c);
+        } else {
+            entry.line.a = pgl_apply_matrix33(sub->transform, entry.line.a);
+            entry.line.b = pgl_apply_matrix33(sub->transform, entry.line.b);
+        }
+        sub->transformed[i] = entry;
+    }
+}
+
+void pgl_render_view(pgl_submission_t* sub, pgl_view_t view) {
+    pgl_vector3_t up = pgl_camera_up(view.cam);
+
+    for (size_t i = 0; i < sub->length; i++) {
+        pgl_renderschedule_entry_t entry = sub->transformed[i];
+        // no clipping yet, so an edge only gets drawn if both of its ends are in view
+        if (entry.type == PGL_TRIANGLE) {
+            pgl_vector2_t a, b, c;
+            bool a_visible = pgl_project_2d_with_up(view.cam, up, entry.triangle.a, &a);
+            bool b_visible = pgl_project_2d_with_up(view.cam, up, entry.triangle.b, &b);
+            bool c_visible = pgl_project_2d_with_up(view.cam, up, entry.triangle.c, &c);
+            if (a_visible && b_visible) {
+                pgl_render_line(view.screen, a, b, entry.color);
+            }
+            if (b_visible && c_visible) {
+                pgl_render_line(view.screen, b, c, entry.color);
+            }
+            if (c_visible && a_visible) {
+                pgl_render_line(view.screen, c, a, entry.color);
+            }
+        } else {
+            pgl_vector2_t a, b;
+            if (pgl_project_2d_with_up(view.cam, up, entry.line.a, &a) &&
+                pgl_project_2d_with_up(view.cam, up, entry.line.b, &b)) {
+                pgl_render_line(view.screen, a, b, entry.color);
+            }
+        }
+    }
+}
+
+void pgl_render_screen_job(void* ctx, unsigned int index) {
+    // views sharing a screen (overlays, picture-in-picture) all get drawn by whichever job has the first of them,
+    // in the order they were given, so no two threads ever write to the same screen
+    pgl_submission_t* sub = (pgl_submission_t*)ctx;
+    pgl_screen_t* screen = sub->views[index].screen;
+    for (unsigned int i = 0; i < index; i++) {
+        if (sub->views[i].screen == screen) {
+            return;
+        }
+    }
+    for (unsigned int i = index; i < sub->view_count; i++) {
+        if (sub->views[i].screen == screen) {
+            pgl_render_view(sub, sub->views[i]);
+        }
+    }
+}
+
+pgl_error_t pgl_submit_renderschedule_multiview(pgl_renderschedule_t sched, pgl_matrix33_t transform,
+                                                pgl_view_t* views, unsigned int view_count) {
+    // transforms everything in sched once, then projects and rasterizes it into every view's screen
+    // big enough submissions render views in parallel, one screen per thread, so extra views are close to free up to
+    // the core count. views may share a screen, in which case they're drawn onto it one after another in order
+    // screens aren't cleared first, that's up to the caller
+    // temporarily allocates a transformed copy of the schedule, which is freed before returning
+
+    pgl_submission_t sub = {
+        .transform = transform,
+        .in = sched.buf,
+        .length = sched.length,
+        .views = views,
+        .view_count = view_count,
+    };
+    sub.transformed = (pgl_renderschedule_entry_t*)malloc(sizeof(pgl_renderschedule_entry_t) * sched.length + 1);
+    if (sub.transformed == NULL) {
+        return PGL_DYNAMIC_ALLOCATION_FAILURE;
+    }
+
+    unsigned int block_count = pgl_thread_count();
+    if (sched.length / PGL_SUBMIT_MIN_BLOCK_LENGTH < block_count) {
+        block_count = (unsigned int)(sched.length / PGL_SUBMIT_MIN_BLOCK_LENGTH);
+    }
+    if (block_count <= 1) {
+        sub.block_length = sched.length;
+        pgl_transform_job(&sub, 0);
+    } else {
+        sub.block_length = (sched.length + block_count - 1) / block_count;
+        pgl_parallel_for(pgl_transform_job, &sub, block_count);
+    }
+
+    if (sched.length * view_count < PGL_SUBMIT_MIN_BLOCK_LENGTH) {
+        for (unsigned int i = 0; i < view_count; i++) {
+            pgl_render_screen_job(&sub, i);
+        }
+    } else {
+        pgl_parallel_for(pgl_render_screen_job, &sub, view_count);
+    }
+
+    free(sub.transformed);
+    return PGL_NO_ERROR;
+}
+
+pgl_error_t pgl_submit_renderschedule(pgl_renderschedule_t sched, pgl_matrix33_t transform, pgl_camera_t cam,
+                                      pgl_screen_t* s) {
+    pgl_view_t view = {cam, s};
+    return pgl_submit_renderschedule_multiview(sched, transform, &view, 1);
+}
 
 /* convenience functions */
 
@@ -0,0 +1,599 @@
+#ifndef PEPPER_MESH_H
+#define PEPPER_MESH_H
+
+#include "pepper_gl.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* pgl_mesh_t and associated operations */
+
+typedef struct pgl_mesh_t {
+    size_t vertex_count;
+    size_t triangle_count;
+    size_t line_count;
+    pgl_vector3_t* vertices;
+    unsigned int* triangles; // three indices into vertices per triangle
+    unsigned int* lines;     // two indices into vertices per line
+} pgl_mesh_t;
+
+pgl_error_t pgl_alloc_mesh(pgl_mesh_t* mesh) {
+    // dynamically allocates memory that must be freed with pgl_destroy_mesh
+    // the counts must already be filled in, and the + 1s keep malloc from handing back NULL for empty meshes
+    mesh->vertices = (pgl_vector3_t*)malloc(sizeof(pgl_vector3_t) * mesh->vertex_count + 1);
+    mesh->triangles = (unsigned int*)malloc(sizeof(unsigned int) * 3 * mesh->triangle_count + 1);
+    mesh->lines = (unsigned int*)malloc(sizeof(unsigned int) * 2 * mesh->line_count + 1);
+    if (mesh->vertices == NULL || mesh->triangles == NULL || mesh->lines == NULL) {
+        free(mesh->vertices);
+        free(mesh->triangles);
+        free(mesh->lines);
+        mesh->vertices = NULL;
+        mesh->triangles = NULL;
+        mesh->lines = NULL;
+        return PGL_DYNAMIC_ALLOCATION_FAILURE;
+    }
+    return PGL_NO_ERROR;
+}
+
+void pgl_destroy_mesh(pgl_mesh_t* mesh) {
+    mesh->vertex_count = 0;
+    mesh->triangle_count = 0;
+    mesh->line_count = 0;
+    free(mesh->vertices);
+    free(mesh->triangles);
+    free(mesh->lines);
+    mesh->vertices = NULL;
+    mesh->triangles = NULL;
+    mesh->lines = NULL;
+}
+
+pgl_error_t pgl_schedule_mesh(pgl_renderschedule_t* sched, pgl_mesh_t mesh, char color) {
+    for (size_t i = 0; i < mesh.triangle_count; i++) {
+        pgl_triangle_t t = {
+            mesh.vertices[mesh.triangles[3 * i]],
+            mesh.vertices[mesh.triangles[3 * i + 1]],
+            mesh.vertices[mesh.triangles[3 * i + 2]],
+        };
+        pgl_error_t err = pgl_schedule_triangle(sched, t, color);
+        if (err != PGL_NO_ERROR) {
+            return err;
+        }
+    }
+    for (size_t i = 0; i < mesh.line_count; i++) {
+        pgl_line_t l = {
+            mesh.vertices[mesh.lines[2 * i]],
+            mesh.vertices[mesh.lines[2 * i + 1]],
+        };
+        pgl_error_t err = pgl_schedule_line(sched, l, color);
+        if (err != PGL_NO_ERROR) {
+            return err;
+        }
+    }
+    return PGL_NO_ERROR;
+}
+
+/* pgl_mapped_file_t and associated operations */
+
+typedef struct pgl_mapped_file_t {
+    const char* buf;
+    size_t length;
+} pgl_mapped_file_t;
+
+pgl_error_t pgl_map_file(const char* path, pgl_mapped_file_t* out) {
+    // maps the whole file read-only, must be unmapped with pgl_unmap_file
+    out->buf = NULL;
+    out->length = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return PGL_FILE_ACCESS_FAILURE;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return PGL_FILE_ACCESS_FAILURE;
+    }
+    if (info.st_size == 0) {
+        // mmap refuses zero-length mappings, but an empty file is still a perfectly good (empty) file
+        close(fd);
+        return PGL_NO_ERROR;
+    }
+
+    void* mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (mapped == MAP_FAILED) {
+        return PGL_FILE_ACCESS_FAILURE;
+    }
+    // these are just hints, so it doesn't matter if the kernel ignores them
+    madvise(mapped, (size_t)info.st_size, MADV_SEQUENTIAL);
+    madvise(mapped, (size_t)info.st_size, MADV_WILLNEED);
+    out->buf = (const char*)mapped;
+    out->length = (size_t)info.st_size;
+    return PGL_NO_ERROR;
+}
+
+void pgl_unmap_file(pgl_mapped_file_t* file) {
+    if (file->buf != NULL) {
+        munmap((void*)file->buf, file->length);
+    }
+    file->buf = NULL;
+    file->length = 0;
+}
+
+/* wavefront obj parsing */
+
+// files smaller than this aren't worth waking up extra threads for
+#define PGL_OBJ_MIN_CHUNK_SIZE (1 << 20)
+
+typedef struct pgl_obj_chunk_t {
+    const char* start;
+    const char* end;
+    size_t vertex_count;
+    size_t triangle_count;
+    size_t line_count;
+    size_t vertex_offset;
+    size_t triangle_offset;
+    size_t line_offset;
+    pgl_mesh_t* out;
+    pgl_error_t err;
+} pgl_obj_chunk_t;
+
+bool pgl_obj_is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char* pgl_obj_skip_blanks(const char* p, const char* end) {
+    while (p < end && pgl_obj_is_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+const char* pgl_obj_skip_token(const char* p, const char* end) {
+    while (p < end && !pgl_obj_is_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+unsigned int pgl_obj_count_tokens(const char* p, const char* end) {
+    unsigned int count = 0;
+    p = pgl_obj_skip_blanks(p, end);
+    while (p < end) {
+        count++;
+        p = pgl_obj_skip_blanks(pgl_obj_skip_token(p, end), end);
+    }
+    return count;
+}
+
+char pgl_obj_keyword(const char* line, const char* end) {
+    // returns 'v', 'f' or 'l' for the line types we care about, 0 for everything else (vt, vn, o, g, etc.)
+    if (end - line < 2 || !pgl_obj_is_blank(line[1])) {
+        return 0;
+    }
+    if (line[0] == 'v' || line[0] == 'f' || line[0] == 'l') {
+        return line[0];
+    }
+    return 0;
+}
+
+bool pgl_parse_double(const char** cursor, const char* end, double* out) {
+    // strtod wants a terminated string and a locale, neither of which a mapped file can promise
+    // precision is limited to 19 significant digits, which is plenty for geometry
+
+    static const double POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const int MAX_DIGITS = 19;
+    const int MAX_EXPONENT = 400;
+
+    const char* p = *cursor;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool seen_digit = false;
+    while (p < end && '0' <= *p && *p <= '9') {
+        if (digits < MAX_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+        seen_digit = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && '0' <= *p && *p <= '9') {
+            if (digits < MAX_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+            seen_digit = true;
+            p++;
+        }
+    }
+    if (!seen_digit) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        if (p == end || *p < '0' || '9' < *p) {
+            return false;
+        }
+        int written_exponent = 0;
+        while (p < end && '0' <= *p && *p <= '9') {
+            if (written_exponent < MAX_EXPONENT) {
+                written_exponent = written_exponent * 10 + (*p - '0');
+            }
+            p++;
+        }
+        exponent += negative_exponent ? -written_exponent : written_exponent;
+    }
+
+    if (mantissa == 0) {
+        // zero times a huge power of ten would be nan, but zero is zero no matter the exponent
+        *out = negative ? -0.0 : 0.0;
+        *cursor = p;
+        return true;
+    }
+
+    // powers of ten up to 22 are exact doubles, so the common case loses nothing here
+    double value = (double)mantissa;
+    if (0 <= exponent && exponent <= 22) {
+        value *= POWERS_OF_TEN[exponent];
+    } else if (-22 <= exponent && exponent < 0) {
+        value /= POWERS_OF_TEN[-exponent];
+    } else if (exponent > 0) {
+        value *= pow(10.0, exponent);
+    } else {
+        value /= pow(10.0, -exponent);
+    }
+    if (!isfinite(value)) {
+        // infinite coordinates would only blow up later in the rasterizer
+        return false;
+    }
+
+    *out = negative ? -value : value;
+    *cursor = p;
+    return true;
+}
+
+bool pgl_parse_index(const char** cursor, const char* end, long* out) {
+    const char* p = *cursor;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || *p < '0' || '9' < *p) {
+        return false;
+    }
+    long value = 0;
+    while (p < end && '0' <= *p && *p <= '9') {
+        if (value > (LONG_MAX - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    *out = negative ? -value : value;
+    *cursor = p;
+    return true;
+}
+
+bool pgl_obj_resolve_index(long index, size_t vertices_so_far, size_t vertex_count, unsigned int* out) {
+    // obj indices start at 1, and negative ones count back from the most recent vertex
+    long resolved;
+    if (index > 0) {
+        resolved = index - 1;
+    } else if (index < 0) {
+        resolved = (long)vertices_so_far + index;
+    } else {
+        return false;
+    }
+    if (resolved < 0 || (size_t)resolved >= vertex_count) {
+        return false;
+    }
+    *out = (unsigned int)resolved;
+    return true;
+}
+
+const char* pgl_obj_line_end(const char* p, const char* end) {
+    const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+    return newline == NULL ? end : newline;
+}
+
+const char* pgl_obj_data_end(const char* p, const char* line_end) {
+    // trailing comments are allowed after data
+    const char* comment = (const char*)memchr(p, '#', (size_t)(line_end - p));
+    return comment == NULL ? line_end : comment;
+}
+
+void pgl_obj_count_job(void* ctx, unsigned int index) {
+    pgl_obj_chunk_t* chunk = &((pgl_obj_chunk_t*)ctx)[index];
+    for (const char* p = chunk->start; p < chunk->end;) {
+        const char* line_end = pgl_obj_line_end(p, chunk->end);
+        const char* line = pgl_obj_skip_blanks(p, line_end);
+        const char* data_end = pgl_obj_data_end(line, line_end);
+        unsigned int tokens;
+        switch (pgl_obj_keyword(line, data_end)) {
+        case 'v':
+            chunk->vertex_count++;
+            break;
+        case 'f':
+            // polygons get fanned out into triangles
+            tokens = pgl_obj_count_tokens(line + 1, data_end);
+            chunk->triangle_count += tokens >= 3 ? tokens - 2 : 0;
+            break;
+        case 'l':
+            // polylines get split into segments
+            tokens = pgl_obj_count_tokens(line + 1, data_end);
+            chunk->line_count += tokens >= 2 ? tokens - 1 : 0;
+            break;
+        }
+        // stepping past a final line with no newline would point beyond the end of the buffer
+        p = line_end < chunk->end ? line_end + 1 : line_end;
+    }
+}
+
+void pgl_obj_fill_job(void* ctx, unsigned int index) {
+    pgl_obj_chunk_t* chunk = &((pgl_obj_chunk_t*)ctx)[index];
+    pgl_mesh_t* mesh = chunk->out;
+    pgl_vector3_t* vertex = mesh->vertices + chunk->vertex_offset;
+    unsigned int* triangle = mesh->triangles + 3 * chunk->triangle_offset;
+    unsigned int* line_segment = mesh->lines + 2 * chunk->line_offset;
+
+    for (const char* p = chunk->start; p < chunk->end;) {
+        const char* line_end = pgl_obj_line_end(p, chunk->end);
+        const char* line = pgl_obj_skip_blanks(p, line_end);
+        const char* data_end = pgl_obj_data_end(line, line_end);
+        char keyword = pgl_obj_keyword(line, data_end);
+        const char* cursor = line + 1;
+        size_t vertices_so_far = (size_t)(vertex - mesh->vertices);
+
+        if (keyword == 'v') {
+            double coords[3];
+            for (unsigned int i = 0; i < 3; i++) {
+                cursor = pgl_obj_skip_blanks(cursor, data_end);
+                if (!pgl_parse_double(&cursor, data_end, &coords[i]) ||
+                    (cursor < data_end && !pgl_obj_is_blank(*cursor))) {
+                    chunk->err = PGL_MALFORMED_FILE;
+                    return;
+                }
+            }
+            *vertex = (pgl_vector3_t){coords[0], coords[1], coords[2]};
+            vertex++;
+        } else if (keyword == 'f' || keyword == 'l') {
+            unsigned int first = 0;
+            unsigned int previous = 0;
+            unsigned int count = 0;
+            cursor = pgl_obj_skip_blanks(cursor, data_end);
+            while (cursor < data_end) {
+                // each token looks like v, v/vt, v//vn, or v/vt/vn, and we only care about v
+                long raw;
+                unsigned int current;
+                if (!pgl_parse_index(&cursor, data_end, &raw) ||
+                    (cursor < data_end && *cursor != '/' && !pgl_obj_is_blank(*cursor)) ||
+                    !pgl_obj_resolve_index(raw, vertices_so_far, mesh->vertex_count, &current)) {
+                    chunk->err = PGL_MALFORMED_FILE;
+                    return;
+                }
+                if (keyword == 'f' && count >= 2) {
+                    triangle[0] = first;
+                    triangle[1] = previous;
+                    triangle[2] = current;
+                    triangle += 3;
+                } else if (keyword == 'l' && count >= 1) {
+                    line_segment[0] = previous;
+                    line_segment[1] = current;
+                    line_segment += 2;
+                }
+                if (count == 0) {
+                    first = current;
+                }
+                previous = current;
+                count++;
+                cursor = pgl_obj_skip_blanks(pgl_obj_skip_token(cursor, data_end), data_end);
+            }
+        }
+        // stepping past a final line with no newline would point beyond the end of the buffer
+        p = line_end < chunk->end ? line_end + 1 : line_end;
+    }
+}
+
+pgl_error_t pgl_parse_mesh_obj(const char* buf, size_t length, pgl_mesh_t* out) {
+    // dynamically allocates memory that must be freed with pgl_destroy_mesh
+    // two passes over the text: one to count, one to fill, both split into chunks that run in parallel
+
+    *out = (pgl_mesh_t){0};
+
+    unsigned int chunk_count = pgl_thread_count();
+    if (length / PGL_OBJ_MIN_CHUNK_SIZE < chunk_count) {
+        chunk_count = (unsigned int)(length / PGL_OBJ_MIN_CHUNK_SIZE);
+    }
+    if (chunk_count == 0) {
+        chunk_count = 1;
+    }
+
+    // chunk boundaries land just after a newline so no line gets split between two chunks
+    pgl_obj_chunk_t chunks[PGL_MAX_THREADS];
+    const char* end = buf + length;
+    const char* start = buf;
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        const char* chunk_end = end;
+        if (i + 1 < chunk_count) {
+            chunk_end = buf + length / chunk_count * (i + 1);
+            if (chunk_end < start) {
+                chunk_end = start;
+            }
+            chunk_end = pgl_obj_line_end(chunk_end, end);
+            if (chunk_end < end) {
+                chunk_end++;
+            }
+        }
+        chunks[i] = (pgl_obj_chunk_t){.start = start, .end = chunk_end, .out = out, .err = PGL_NO_ERROR};
+        start = chunk_end;
+    }
+
+    pgl_parallel_for(pgl_obj_count_job, chunks, chunk_count);
+
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        chunks[i].vertex_offset = out->vertex_count;
+        chunks[i].triangle_offset = out->triangle_count;
+        chunks[i].line_offset = out->line_count;
+        out->vertex_count += chunks[i].vertex_count;
+        out->triangle_count += chunks[i].triangle_count;
+        out->line_count += chunks[i].line_count;
+    }
+    if (out->vertex_count > UINT_MAX) {
+        // indices wouldn't fit in an unsigned int
+        *out = (pgl_mesh_t){0};
+        return PGL_MALFORMED_FILE;
+    }
+
+    pgl_error_t err = pgl_alloc_mesh(out);
+    if (err != PGL_NO_ERROR) {
+        *out = (pgl_mesh_t){0};
+        return err;
+    }
+
+    pgl_parallel_for(pgl_obj_fill_job, chunks, chunk_count);
+
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        if (chunks[i].err != PGL_NO_ERROR) {
+            pgl_destroy_mesh(out);
+            return chunks[i].err;
+        }
+    }
+    return PGL_NO_ERROR;
+}
+
+/* binary mesh format */
+
+// layout, in native byte order:
+//   8 byte magic, then vertex_count, triangle_count, line_count as uint64_t
+//   vertex_count vertices as three doubles each
+//   triangle_count triangles as three uint32_t indices each
+//   line_count lines as two uint32_t indices each
+// it's just the in-memory layout of pgl_mesh_t written out, so loading is a bounds check and a memcpy
+
+#define PGL_MESH_MAGIC "PGLMESH1"
+#define PGL_MESH_MAGIC_LENGTH 8
+#define PGL_MESH_HEADER_LENGTH (PGL_MESH_MAGIC_LENGTH + 3 * sizeof(uint64_t))
+
+_Static_assert(sizeof(pgl_vector3_t) == 3 * sizeof(double), "pgl_vector3_t must be tightly packed");
+_Static_assert(sizeof(unsigned int) == sizeof(uint32_t), "mesh indices are stored as uint32_t");
+
+bool pgl_is_mesh_binary(const char* buf, size_t length) {
+    return length >= PGL_MESH_MAGIC_LENGTH && memcmp(buf, PGL_MESH_MAGIC, PGL_MESH_MAGIC_LENGTH) == 0;
+}
+
+bool pgl_mesh_indices_valid(const unsigned int* indices, size_t count, size_t vertex_count) {
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] >= vertex_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+pgl_error_t pgl_parse_mesh_binary(const char* buf, size_t length, pgl_mesh_t* out) {
+    // dynamically allocates memory that must be freed with pgl_destroy_mesh
+
+    *out = (pgl_mesh_t){0};
+    if (length < PGL_MESH_HEADER_LENGTH || !pgl_is_mesh_binary(buf, length)) {
+        return PGL_MALFORMED_FILE;
+    }
+
+    uint64_t counts[3];
+    memcpy(counts, buf + PGL_MESH_MAGIC_LENGTH, sizeof(counts));
+    // guard the size arithmetic below against absurd counts before trusting them
+    if (counts[0] > UINT_MAX || counts[0] > SIZE_MAX / sizeof(pgl_vector3_t) ||
+        counts[1] > SIZE_MAX / (3 * sizeof(uint32_t)) || counts[2] > SIZE_MAX / (2 * sizeof(uint32_t))) {
+        return PGL_MALFORMED_FILE;
+    }
+    size_t vertex_bytes = (size_t)counts[0] * sizeof(pgl_vector3_t);
+    size_t triangle_bytes = (size_t)counts[1] * 3 * sizeof(uint32_t);
+    size_t line_bytes = (size_t)counts[2] * 2 * sizeof(uint32_t);
+    // checked one term at a time so the sum can't wrap around and sneak past
+    size_t remaining = length - PGL_MESH_HEADER_LENGTH;
+    if (vertex_bytes > remaining || triangle_bytes > remaining - vertex_bytes ||
+        line_bytes != remaining - vertex_bytes - triangle_bytes) {
+        return PGL_MALFORMED_FILE;
+    }
+
+    out->vertex_count = (size_t)counts[0];
+    out->triangle_count = (size_t)counts[1];
+    out->line_count = (size_t)counts[2];
+    pgl_error_t err = pgl_alloc_mesh(out);
+    if (err != PGL_NO_ERROR) {
+        *out = (pgl_mesh_t){0};
+        return err;
+    }
+
+    const char* p = buf + PGL_MESH_HEADER_LENGTH;
+    memcpy(out->vertices, p, vertex_bytes);
+    memcpy(out->triangles, p + vertex_bytes, triangle_bytes);
+    memcpy(out->lines, p + vertex_bytes + triangle_bytes, line_bytes);
+
+    if (!pgl_mesh_indices_valid(out->triangles, 3 * out->triangle_count, out->vertex_count) ||
+        !pgl_mesh_indices_valid(out->lines, 2 * out->line_count, out->vertex_count)) {
+        pgl_destroy_mesh(out);
+        return PGL_MALFORMED_FILE;
+    }
+    return PGL_NO_ERROR;
+}
+
+pgl_error_t pgl_save_mesh_binary(pgl_mesh_t mesh, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return PGL_FILE_ACCESS_FAILURE;
+    }
+    uint64_t counts[3] = {mesh.vertex_count, mesh.triangle_count, mesh.line_count};
+    bool ok = fwrite(PGL_MESH_MAGIC, 1, PGL_MESH_MAGIC_LENGTH, file) == PGL_MESH_MAGIC_LENGTH &&
+              fwrite(counts, sizeof(counts), 1, file) == 1 &&
+              fwrite(mesh.vertices, sizeof(pgl_vector3_t), mesh.vertex_count, file) == mesh.vertex_count &&
+              fwrite(mesh.triangles, 3 * sizeof(uint32_t), mesh.triangle_count, file) == mesh.triangle_count &&
+              fwrite(mesh.lines, 2 * sizeof(uint32_t), mesh.line_count, file) == mesh.line_count;
+    if (fclose(file) != 0 || !ok) {
+        return PGL_FILE_ACCESS_FAILURE;
+    }
+    return PGL_NO_ERROR;
+}
+
+/* loading from disk */
+
+pgl_error_t pgl_load_mesh(const char* path, pgl_mesh_t* out) {
+    // dynamically allocates memory that must be freed with pgl_destroy_mesh
+    // binary meshes are recognized by their magic, anything else is parsed as wavefront obj
+
+    *out = (pgl_mesh_t){0};
+    pgl_mapped_file_t file;
+    pgl_error_t err = pgl_map_file(path, &file);
+    if (err != PGL_NO_ERROR) {
+        return err;
+    }
+    if (pgl_is_mesh_binary(file.buf, file.length)) {
+        err = pgl_parse_mesh_binary(file.buf, file.length, out);
+    } else {
+        err = pgl_parse_mesh_obj(file.buf, file.length, out);
+    }
+    pgl_unmap_file(&file);
+    return err;
+}
+
+#endif
@@ -11,6 +11,8 @@
 #define SCREEN_HEIGHT 40
 #define SCREEN_WIDTH 80
 
+PGL_DEFINE_FIXED_SCREEN(cube, SCREEN_WIDTH, SCREEN_HEIGHT)
+
 int main() {
     const pgl_vector3_t CUBE_POINTS_INITIAL[8] = {
         {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1},
@@ -26,20 +28,19 @@ int main() {
         {1, 0, 0},
     };
 
-    char screen_data[SCREEN_WIDTH][SCREEN_HEIGHT];
-    pgl_screen_t screen = {SCREEN_WIDTH, SCREEN_HEIGHT, (char*)screen_data};
+    pgl_screen_cube_t screen;
     pgl_vector2_t projected_points[8];
     while (true) {
-        pgl_screen_clear(&screen, ' ');
+        pgl_screen_cube_clear(&screen, ' ');
         double scale = (double)clock() / CLOCKS_PER_SEC;
         pgl_matrix33_t rotation_matrix = pgl_gen_rotation_matrix(YAW * scale, PITCH * scale, ROLL * scale);
         for (unsigned int i = 0; i < 8; i++) {
             pgl_project_2d(cam, pgl_apply_matrix33(rotation_matrix, CUBE_POINTS_INITIAL[i]), &projected_points[i]);
         }
         for (unsigned int i = 0; i < 12; i++) {
-            pgl_render_line(&screen, projected_points[CUBE_EDGES[i][0]], projected_points[CUBE_EDGES[i][1]], 'O');
+            pgl_render_line_cube(&screen, projected_points[CUBE_EDGES[i][0]], projected_points[CUBE_EDGES[i][1]], 'O');
         }
-        pgl_draw_screen(screen, stdout);
+        pgl_draw_screen_cube(&screen, stdout);
     }
 
     return 0;
@@ -0,0 +1,75 @@
+#include "pepper_gl.h"
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+// in units of radians
+#define YAW 0.45
+#define PITCH 2.6
+#define ROLL 0.9
+
+#define SCREEN_HEIGHT 30
+#define SCREEN_WIDTH 50
+#define VIEW_COUNT 3
+
+void draw_screens_side_by_side(pgl_screen_t* screens, unsigned int count, FILE* out) {
+    fprintf(out, "\033[H\033[2J"); // clear screen and pointer to home position
+    for (size_t line = 0; line < screens[0].height; line++) {
+        for (unsigned int i = 0; i < count; i++) {
+            fprintf(out, "%.*s|", (int)screens[i].width, screens[i].buf + line * screens[i].width);
+        }
+        fprintf(out, "\n");
+    }
+    fflush(out);
+}
+
+int main() {
+    const pgl_vector3_t CUBE_POINTS_INITIAL[8] = {
+        {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1},
+    };
+
+    const unsigned int CUBE_EDGES[12][2] = {{0, 1}, {0, 2}, {0, 4}, {7, 6}, {7, 5}, {7, 3},
+                                            {1, 3}, {3, 2}, {2, 6}, {6, 4}, {4, 5}, {5, 1}};
+
+    pgl_renderschedule_t sched;
+    if (pgl_init_renderschedule(&sched) != PGL_NO_ERROR) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (unsigned int i = 0; i < 12; i++) {
+        pgl_line_t edge = {CUBE_POINTS_INITIAL[CUBE_EDGES[i][0]], CUBE_POINTS_INITIAL[CUBE_EDGES[i][1]]};
+        if (pgl_schedule_line(&sched, edge, 'O') != PGL_NO_ERROR) {
+            fprintf(stderr, "out of memory\n");
+            pgl_destroy_renderschedule(&sched);
+            return 1;
+        }
+    }
+
+    // front, side, and a bit further back
+    char screen_data[VIEW_COUNT][SCREEN_HEIGHT][SCREEN_WIDTH];
+    pgl_screen_t screens[VIEW_COUNT];
+    pgl_view_t views[VIEW_COUNT] = {
+        {{M_PI_2, {0, 0, -3}, {0, 0, 1}, {1, 0, 0}}, &screens[0]},
+        {{M_PI_2, {-3, 0, 0}, {1, 0, 0}, {0, 0, -1}}, &screens[1]},
+        {{M_PI_2, {0, 0, -5}, {0, 0, 1}, {1, 0, 0}}, &screens[2]},
+    };
+    for (unsigned int i = 0; i < VIEW_COUNT; i++) {
+        screens[i] = (pgl_screen_t){SCREEN_WIDTH, SCREEN_HEIGHT, (char*)screen_data[i]};
+    }
+
+    while (true) {
+        for (unsigned int i = 0; i < VIEW_COUNT; i++) {
+            pgl_screen_clear(&screens[i], ' ');
+        }
+        double scale = (double)clock() / CLOCKS_PER_SEC;
+        pgl_matrix33_t rotation_matrix = pgl_gen_rotation_matrix(YAW * scale, PITCH * scale, ROLL * scale);
+        if (pgl_submit_renderschedule_multiview(sched, rotation_matrix, views, VIEW_COUNT) != PGL_NO_ERROR) {
+            fprintf(stderr, "out of memory\n");
+            break;
+        }
+        draw_screens_side_by_side(screens, VIEW_COUNT, stdout);
+    }
+
+    pgl_destroy_renderschedule(&sched);
+    return 1;
+}